@@ -1,6 +1,11 @@
 #ifndef __LOGGER_HPP__
 #define __LOGGER_HPP__
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
 #include <string>
 // #include <format>
@@ -195,6 +200,43 @@ struct LocationInfo {
   ~LocationInfo() = default;
 };
 
+/**
+    @brief 日志索引文件(xxx.log.idx)中的一条记录, 描述日志文件中的一个分段
+    每行格式: offset length minTime maxTime cnt[INFO] ... cnt[TRACE]
+    offset/length 为分段在日志文件中的字节区间, 且总是从行首开始
+    minTime/maxTime 为分段内日志的最早/最晚时间(epoch 毫秒)
+*/
+struct IndexSegment {
+  size_t _offset{0};
+  size_t _length{0};
+  int64_t _minTime{0};
+  int64_t _maxTime{0};
+  std::array<size_t, 6> _levelCount{};
+
+  std::string serialize() const {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+             "%zu %zu %lld %lld %zu %zu %zu %zu %zu %zu\n", _offset, _length,
+             static_cast<long long>(_minTime),
+             static_cast<long long>(_maxTime), _levelCount[0], _levelCount[1],
+             _levelCount[2], _levelCount[3], _levelCount[4], _levelCount[5]);
+    return std::string(buffer);
+  }
+
+  static bool parse(const std::string& line, IndexSegment& seg) {
+    long long minTime = 0;
+    long long maxTime = 0;
+    int n = sscanf(line.c_str(), "%zu %zu %lld %lld %zu %zu %zu %zu %zu %zu",
+                   &seg._offset, &seg._length, &minTime, &maxTime,
+                   &seg._levelCount[0], &seg._levelCount[1],
+                   &seg._levelCount[2], &seg._levelCount[3],
+                   &seg._levelCount[4], &seg._levelCount[5]);
+    seg._minTime = minTime;
+    seg._maxTime = maxTime;
+    return n == 10;
+  }
+};
+
 class Message {
  public:
   explicit Message(LOGLEVEL level, std::string str, LocationInfo&& tLoc)
@@ -288,6 +330,15 @@ class Message {
   std::string_view getLevelFlag() const noexcept {
     return LevelFlag[static_cast<int>(_levle)];
   }
+  static constexpr std::string_view getLevelFlag(LOGLEVEL level) noexcept {
+    return LevelFlag[static_cast<int>(level)];
+  }
+  LOGLEVEL getLevel() const noexcept { return _levle; }
+  int64_t getProduceTime() const noexcept {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               _ProduceTime.time_since_epoch())
+        .count();
+  }
 
  private:
   LOGLEVEL _levle;
@@ -369,8 +420,16 @@ class Logger : public Singleton<Logger> {
 
   void writeMsgbuffer() {
     for (auto& msg : _writeBuffer) {
+      size_t lineOffset = _fileOffset + _fileStringBuffer.size();
       _fileStringBuffer += msg.formatMsg();
       _fileStringBuffer += "\n";
+      if (_logcof._isIndex) {
+        indexMsg(msg, lineOffset, _fileOffset + _fileStringBuffer.size());
+      } else if (_indexSegment._length != 0) {
+        // 索引关闭期间的日志留在分段之外, 由读取方按未索引区间扫描
+        _indexStringBuffer += _indexSegment.serialize();
+        _indexSegment = IndexSegment{};
+      }
       if (_logcof._isConsle) {
         if (_logcof._isColor) {
           _consoleStringBuffer += msg.getLevelColor();
@@ -387,7 +446,9 @@ class Logger : public Singleton<Logger> {
         if (_logout.is_open()) {
           _logout.write(_fileStringBuffer.data(), _fileStringBuffer.size());
           _logout.flush();
+          _fileOffset += _fileStringBuffer.size();
           _fileStringBuffer.clear();
+          writeIndex(false);
         }
         rotateFile();
       }
@@ -406,6 +467,7 @@ class Logger : public Singleton<Logger> {
       _buffer.dequeen(_writeBuffer, _batchSize);
       if (!_writeBuffer.empty()) {
         writeMsgbuffer();
+        _processedNum += _writeBuffer.size();
         _writeBuffer.clear();
       }
     }
@@ -413,7 +475,9 @@ class Logger : public Singleton<Logger> {
       if (_logout.is_open()) {
         _logout.write(_fileStringBuffer.data(), _fileStringBuffer.size());
         _logout.flush();
+        _fileOffset += _fileStringBuffer.size();
         _fileStringBuffer.clear();
+        writeIndex(true);
       }
       rotateFile();
     }
@@ -428,7 +492,7 @@ class Logger : public Singleton<Logger> {
 
   void rotateFile() {
     if (!_logcof._isRotate) return;
-    std::string file_path = getLognName().append(".log");
+    std::string file_path = _logName + ".log";
     int filesize = 0;
     if (std::filesystem::exists(file_path) &&
         std::filesystem::is_regular_file(file_path)) {
@@ -442,16 +506,61 @@ class Logger : public Singleton<Logger> {
     char timestamp[32];
     std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S",
                   std::localtime(&time));
-    std::string new_name = getLognName();
+    std::string new_name = _logName;
     new_name += "_";
     new_name += std::string(timestamp);
     new_name += ".log";
     if (std::filesystem::exists(file_path)) {
       std::filesystem::rename(file_path, new_name);
     }
+    // index of the rotated file follows it: app_xxx.log -> app_xxx.log.idx
+    writeIndex(true);
+    if (_indexout.is_open()) {
+      _indexout.close();
+      std::string index_path = file_path + ".idx";
+      if (std::filesystem::exists(index_path)) {
+        std::filesystem::rename(index_path, new_name + ".idx");
+      }
+    }
+    _fileOffset = 0;
     _logout.open(file_path);
   }
 
+  // 将日志行计入当前索引分段, 分段达到 _indexInterval 字节后封闭
+  void indexMsg(const Message& msg, size_t begin, size_t end) {
+    int64_t time = msg.getProduceTime();
+    if (_indexSegment._length == 0) {
+      _indexSegment._offset = begin;
+      _indexSegment._minTime = time;
+      _indexSegment._maxTime = time;
+    }
+    _indexSegment._minTime = std::min(_indexSegment._minTime, time);
+    _indexSegment._maxTime = std::max(_indexSegment._maxTime, time);
+    ++_indexSegment._levelCount[static_cast<int>(msg.getLevel())];
+    _indexSegment._length = end - _indexSegment._offset;
+    if (_indexSegment._length >= _logcof._indexInterval) {
+      _indexStringBuffer += _indexSegment.serialize();
+      _indexSegment = IndexSegment{};
+    }
+  }
+
+  // 日志内容落盘后再写索引, 保证索引不会指向文件中尚不存在的数据
+  void writeIndex(bool closeSegment) {
+    if (closeSegment && _indexSegment._length != 0) {
+      _indexStringBuffer += _indexSegment.serialize();
+      _indexSegment = IndexSegment{};
+    }
+    if (_indexStringBuffer.empty()) return;
+    if (!_indexout.is_open()) {
+      _indexout.open(_logName + ".log.idx");
+    }
+    if (_indexout.is_open()) {
+      _indexout.write(_indexStringBuffer.data(), _indexStringBuffer.size());
+      _indexout.flush();
+    }
+    _indexStringBuffer.clear();
+  }
+
  private:
   struct logConf {
     bool _isStop;
@@ -459,7 +568,9 @@ class Logger : public Singleton<Logger> {
     bool _isConsle;
     bool _isWritefile;
     bool _isRotate;
+    bool _isIndex;
     size_t _fileMaxSize;
+    size_t _indexInterval;
     size_t _fileNum;
     std::string _logDirName;
     std::string _logPrefixPath;
@@ -471,6 +582,8 @@ class Logger : public Singleton<Logger> {
           _isColor(true),
           _isWritefile(true),
           _isRotate(false),
+          _isIndex(false),
+          _indexInterval(1024 * 64),
           _logDirName("log"),
           _isStop(false),
           _logPrefixPath("."),
@@ -535,9 +648,21 @@ class Logger : public Singleton<Logger> {
     _logcof._isRotate = isRotate;
     return *this;
   }
+  Logger& setIndex(bool isIndex) {
+    _logcof._isIndex = isIndex;
+    return *this;
+  }
+  Logger& setIndexInterval(size_t indexInterval) {
+    _logcof._indexInterval = indexInterval;
+    return *this;
+  }
+  // 工作线程已处理(格式化并计入索引)的日志条数, 此时尚不一定落盘
+  size_t getProcessedNum() const { return _processedNum; }
 
  private:
   std::ofstream _logout;
+  std::ofstream _indexout;
+  std::string _logName;
   BufferQueen<Message> _buffer;
   std::thread _workThread;
   logConf _logcof;
@@ -549,6 +674,10 @@ class Logger : public Singleton<Logger> {
   std::string _consoleStringBuffer;
   size_t _fileCurrentBufferSize;
   size_t _consoleCurrentBufferSize;
+  size_t _fileOffset{0};
+  std::atomic<size_t> _processedNum{0};
+  IndexSegment _indexSegment;
+  std::string _indexStringBuffer;
   thread_local inline static std::vector<Message> _writeBuffer;
   void initiallize() {
     constexpr size_t _iQueenBufferSize = 1 << 13;  // ciculQueen size 1024 * 8
@@ -558,7 +687,11 @@ class Logger : public Singleton<Logger> {
     _writeBuffer.reserve(_batchSize);
 
     createlogDir();
-    _logout.open(getLognName().append(".log"));
+    // 文件只在此处打开一次, 轮转与索引均基于此时的文件名
+    _logName = getLognName();
+    _logout.open(_logName + ".log");
+    // 日志文件已被截断重写, 旧的索引不再有效
+    std::filesystem::remove(_logName + ".log.idx");
 
     setConsle(false).setRotate(false);
 
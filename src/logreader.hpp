@@ -0,0 +1,423 @@
+#ifndef __LOGREADER_HPP__
+#define __LOGREADER_HPP__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "logger.hpp"
+
+namespace yoyo {
+
+// 只读映射整个日志文件, 映射建立后即可关闭文件描述符
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& path) { open(path); }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { close(); }
+
+  bool open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+    }
+    _size = static_cast<size_t>(st.st_size);
+    if (_size > 0) {
+      void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        ::close(fd);
+        _size = 0;
+        return false;
+      }
+      _data = static_cast<const char*>(addr);
+    }
+    ::close(fd);
+    return true;
+  }
+
+  void close() {
+    if (_data != nullptr) {
+      ::munmap(const_cast<char*>(_data), _size);
+    }
+    _data = nullptr;
+    _size = 0;
+  }
+
+  // 提示内核按区间顺序预读, 跳过的分段不会被读入
+  void willNeed(size_t begin, size_t end) const {
+    if (_data == nullptr || begin >= end) return;
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t aligned = begin - begin % page;
+    ::madvise(const_cast<char*>(_data) + aligned, end - aligned,
+              MADV_WILLNEED);
+  }
+
+  std::string_view view() const { return {_data, _size}; }
+  size_t size() const { return _size; }
+
+ private:
+  const char* _data{nullptr};
+  size_t _size{0};
+};
+
+/**
+    @brief 一行日志解析后的各字段, 均指向原始数据
+    日志格式: [time][level][fileName:function:line:msg]
+*/
+struct LogRecord {
+  std::string_view _time;
+  std::string_view _level;
+  std::string_view _fileName;
+  std::string_view _Function;
+  std::string_view _Line;
+  std::string_view _sMsg;
+};
+
+inline bool parseLogLine(std::string_view line, LogRecord& rec) {
+  if (line.size() < 2 || line[0] != '[') return false;
+  size_t timeEnd = line.find(']', 1);
+  if (timeEnd == std::string_view::npos || timeEnd + 1 >= line.size() ||
+      line[timeEnd + 1] != '[') {
+    return false;
+  }
+  size_t levelEnd = line.find(']', timeEnd + 2);
+  if (levelEnd == std::string_view::npos || levelEnd + 1 >= line.size() ||
+      line[levelEnd + 1] != '[') {
+    return false;
+  }
+  rec._time = line.substr(1, timeEnd - 1);
+  rec._level = line.substr(timeEnd + 2, levelEnd - timeEnd - 2);
+
+  std::string_view body = line.substr(levelEnd + 2);
+  if (!body.empty() && body.back() == ']') body.remove_suffix(1);
+  size_t fileEnd = body.find(':');
+  if (fileEnd == std::string_view::npos) return false;
+  rec._fileName = body.substr(0, fileEnd);
+
+  // 函数签名中可能含有"::", 以第一个 ":数字:" 作为行号的位置
+  std::string_view rest = body.substr(fileEnd + 1);
+  for (size_t pos = rest.find(':'); pos != std::string_view::npos;
+       pos = rest.find(':', pos + 1)) {
+    size_t digit = pos + 1;
+    while (digit < rest.size() &&
+           std::isdigit(static_cast<unsigned char>(rest[digit]))) {
+      ++digit;
+    }
+    if (digit > pos + 1 && digit < rest.size() && rest[digit] == ':') {
+      rec._Function = rest.substr(0, pos);
+      rec._Line = rest.substr(pos + 1, digit - pos - 1);
+      rec._sMsg = rest.substr(digit + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+class LogFilter {
+ public:
+  LogFilter() { _levels.fill(true); }
+
+  /**
+      @brief 设置时间窗口, 格式 "YYYY-MM-DD[ HH[:MM[:SS[.mmm]]]]"
+      起始时间缺省的部分补最小值, 结束时间缺省的部分补最大值
+  */
+  bool setFrom(const std::string& str) {
+    return parseTime(str, false, _from, _fromTime);
+  }
+  bool setTo(const std::string& str) {
+    return parseTime(str, true, _to, _toTime);
+  }
+  // 逗号分隔的级别列表, 支持前缀且不区分大小写, 如 "error,warn" 或 "E,W"
+  bool setLevels(const std::string& str) {
+    _levels.fill(false);
+    size_t begin = 0;
+    while (begin <= str.size()) {
+      size_t end = str.find(',', begin);
+      if (end == std::string::npos) end = str.size();
+      std::string token = str.substr(begin, end - begin);
+      for (auto& c : token) c = std::toupper(static_cast<unsigned char>(c));
+      bool found = false;
+      for (size_t i = 0; i < _levels.size() && !token.empty(); ++i) {
+        if (Message::getLevelFlag(static_cast<LOGLEVEL>(i))
+                .starts_with(token)) {
+          _levels[i] = true;
+          found = true;
+        }
+      }
+      if (!found) return false;
+      begin = end + 1;
+    }
+    return true;
+  }
+  void setFileName(std::string fileName) { _fileName = std::move(fileName); }
+  void setFunction(std::string function) { _Function = std::move(function); }
+
+  // 分段的时间区间与窗口相交, 且含有所需级别的日志
+  bool matchSegment(const IndexSegment& seg) const {
+    if (seg._maxTime < _fromTime || seg._minTime > _toTime) return false;
+    for (size_t i = 0; i < _levels.size(); ++i) {
+      if (_levels[i] && seg._levelCount[i] != 0) return true;
+    }
+    return false;
+  }
+
+  bool match(const LogRecord& rec) const {
+    // 时间字符串定长且按字典序即时间序, 无需逐行转换
+    if (!_from.empty() && rec._time < _from) return false;
+    if (!_to.empty() && rec._time > _to) return false;
+    bool levelMatch = false;
+    for (size_t i = 0; i < _levels.size(); ++i) {
+      if (Message::getLevelFlag(static_cast<LOGLEVEL>(i)) == rec._level) {
+        levelMatch = _levels[i];
+        break;
+      }
+    }
+    if (!levelMatch) return false;
+    if (!_fileName.empty() &&
+        rec._fileName.find(_fileName) == std::string_view::npos) {
+      return false;
+    }
+    if (!_Function.empty() &&
+        rec._Function.find(_Function) == std::string_view::npos) {
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  static bool parseTime(const std::string& str, bool isUpper,
+                        std::string& text, int64_t& time) {
+    int v[6] = {0, 1, 1, 0, 0, 0};
+    char fraction[16] = {0};
+    int n = sscanf(str.c_str(), "%d-%d-%d%*[ T]%d:%d:%d.%15[0-9]", &v[0],
+                   &v[1], &v[2], &v[3], &v[4], &v[5], fraction);
+    if (n < 3) return false;
+    if (isUpper) {
+      constexpr int upper[6] = {0, 0, 0, 23, 59, 59};
+      for (int i = std::max(n, 3); i < 6; ++i) v[i] = upper[i];
+    }
+    if (v[1] < 1 || v[1] > 12 || v[2] < 1 || v[2] > 31 || v[3] < 0 ||
+        v[3] > 23 || v[4] < 0 || v[4] > 59 || v[5] < 0 || v[5] > 59) {
+      return false;
+    }
+    // 小数部分按位取毫秒: ".5" 为 500ms, 超出 3 位的部分截断
+    int millisecond = isUpper ? 999 : 0;
+    if (n == 7) {
+      millisecond = 0;
+      for (int i = 0; i < 3; ++i) {
+        char c = fraction[i] != '\0' ? fraction[i] : (isUpper ? '9' : '0');
+        millisecond = millisecond * 10 + (c - '0');
+      }
+    }
+
+    struct tm curtime {};
+    curtime.tm_year = v[0] - 1900;
+    curtime.tm_mon = v[1] - 1;
+    curtime.tm_mday = v[2];
+    curtime.tm_hour = v[3];
+    curtime.tm_min = v[4];
+    curtime.tm_sec = v[5];
+    curtime.tm_isdst = -1;
+    std::time_t timet = std::mktime(&curtime);
+    // mktime 会把 02-30 之类的日期顺延到下个月, 视为非法
+    if (timet == -1 || curtime.tm_mon != v[1] - 1 || curtime.tm_mday != v[2]) {
+      return false;
+    }
+    time = static_cast<int64_t>(timet) * 1000 + millisecond;
+
+    // 基于归一化后的时间生成文本, 保证与 time 一致
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%4d-%02d-%02d %02d:%02d:%02d.%03d",
+             curtime.tm_year + 1900, curtime.tm_mon + 1, curtime.tm_mday,
+             curtime.tm_hour, curtime.tm_min, curtime.tm_sec, millisecond);
+    text = buffer;
+    return true;
+  }
+
+ private:
+  std::string _from;
+  std::string _to;
+  int64_t _fromTime{std::numeric_limits<int64_t>::min()};
+  int64_t _toTime{std::numeric_limits<int64_t>::max()};
+  std::array<bool, 6> _levels;
+  std::string _fileName;
+  std::string _Function;
+};
+
+/**
+    @brief 按条件读取日志文件
+    存在 xxx.log.idx 时只扫描与条件相交的分段, 以及索引尚未覆盖的文件尾部
+    不存在索引时退化为整个文件扫描
+*/
+class LogReader {
+ public:
+  using Sink = std::function<void(std::string_view)>;
+
+  explicit LogReader(LogFilter filter, bool useIndex = true)
+      : _filter(std::move(filter)), _useIndex(useIndex) {}
+
+  /**
+      @brief 输出文件中所有匹配的行
+      @param isPartialTail 是否输出文件末尾不完整的行
+      @return 已处理内容的结束偏移, 可作为 follow 的起点
+  */
+  size_t read(const std::string& path, const Sink& sink,
+              bool isPartialTail = true) {
+    MappedFile file;
+    if (!file.open(path)) {
+      throw std::runtime_error("cannot open log file: " + path);
+    }
+    std::string_view data = file.view();
+    std::vector<std::pair<size_t, size_t>> ranges;
+    auto addRange = [&ranges](size_t begin, size_t end) {
+      if (begin >= end) return;
+      if (!ranges.empty() && ranges.back().second == begin) {
+        ranges.back().second = end;
+      } else {
+        ranges.emplace_back(begin, end);
+      }
+    };
+    // 索引未覆盖的区间(开启索引前写入的内容、文件尾部)总是需要扫描
+    size_t scanned = 0;
+    if (_useIndex) {
+      for (const auto& seg : loadIndex(path + ".idx", data)) {
+        addRange(scanned, seg._offset);
+        scanned = seg._offset + seg._length;
+        if (_filter.matchSegment(seg)) addRange(seg._offset, scanned);
+      }
+    }
+    addRange(scanned, data.size());
+
+    size_t end = data.size();
+    for (const auto& [begin, rangeEnd] : ranges) {
+      file.willNeed(begin, rangeEnd);
+      bool isLastMatch = false;
+      if (rangeEnd == data.size()) {
+        end = scanRange(data, begin, rangeEnd, sink, isPartialTail,
+                        isLastMatch);
+      } else {
+        scanRange(data, begin, rangeEnd, sink, true, isLastMatch);
+      }
+    }
+    return end;
+  }
+
+  /**
+      @brief 从 offset 处持续跟踪文件新增内容, 直到调用 stop()
+      文件被轮转(重命名后新建)时先读完旧文件, 再从新文件开头继续
+  */
+  void follow(const std::string& path, size_t offset, const Sink& sink,
+              std::chrono::milliseconds interval =
+                  std::chrono::milliseconds(200)) {
+    std::ifstream ifs(path, std::ios::binary);
+    struct stat st;
+    ino_t inode = ::stat(path.c_str(), &st) == 0 ? st.st_ino : 0;
+    std::string pending;
+    bool isLastMatch = false;
+    std::vector<char> chunk(1024 * 64);
+    auto drain = [&](bool isPartialTail) {
+      if (!ifs.is_open()) return;
+      ifs.clear();
+      ifs.seekg(offset);
+      while (ifs.read(chunk.data(), chunk.size()) || ifs.gcount() > 0) {
+        pending.append(chunk.data(), ifs.gcount());
+        offset += ifs.gcount();
+      }
+      size_t end = scanRange(pending, 0, pending.size(), sink, isPartialTail,
+                             isLastMatch);
+      pending.erase(0, end);
+    };
+    _isStop = false;
+    while (!_isStop) {
+      drain(false);
+      if (::stat(path.c_str(), &st) == 0 &&
+          (st.st_ino != inode || static_cast<size_t>(st.st_size) < offset)) {
+        // 上次读取与 stat 之间旧文件可能又写入了最后的内容, 轮转时再读一次
+        if (st.st_ino != inode) drain(true);
+        inode = st.st_ino;
+        offset = 0;
+        pending.clear();
+        isLastMatch = false;
+        ifs.close();
+        ifs.open(path, std::ios::binary);
+        continue;
+      }
+      std::this_thread::sleep_for(interval);
+    }
+  }
+
+  void stop() { _isStop = true; }
+
+ private:
+  /**
+      @brief 读取索引, 分段需按偏移递增且从行首开始, 分段之间允许有空隙
+      遇到与当前文件不符的记录(如文件已被截断重写)时丢弃其后的部分
+  */
+  static std::vector<IndexSegment> loadIndex(const std::string& path,
+                                             std::string_view data) {
+    std::vector<IndexSegment> segments;
+    std::ifstream ifs(path);
+    std::string line;
+    size_t expected = 0;
+    while (std::getline(ifs, line) && !ifs.eof()) {
+      IndexSegment seg;
+      if (!IndexSegment::parse(line, seg)) break;
+      if (seg._offset < expected || seg._offset + seg._length > data.size() ||
+          (seg._offset != 0 && data[seg._offset - 1] != '\n')) {
+        break;
+      }
+      expected = seg._offset + seg._length;
+      segments.emplace_back(seg);
+    }
+    return segments;
+  }
+
+  /**
+      @brief 扫描 [begin, end) 中的完整行, 无法解析的行视为上一条日志的续行
+      @param isLastMatch 上一条日志是否匹配, 跨多次调用保持续行的匹配状态
+      @return 最后一个已处理行的结束偏移
+  */
+  size_t scanRange(std::string_view data, size_t begin, size_t end,
+                   const Sink& sink, bool isPartialTail, bool& isLastMatch) {
+    LogRecord rec;
+    while (begin < end) {
+      const char* lineEnd = static_cast<const char*>(
+          std::memchr(data.data() + begin, '\n', end - begin));
+      if (lineEnd == nullptr && !isPartialTail) break;
+      size_t next = lineEnd == nullptr ? end : lineEnd - data.data() + 1;
+      std::string_view line = data.substr(begin, next - begin);
+      if (parseLogLine(line.substr(0, line.find('\n')), rec)) {
+        isLastMatch = _filter.match(rec);
+      }
+      if (isLastMatch) {
+        sink(line);
+        if (lineEnd == nullptr) sink("\n");
+      }
+      begin = next;
+    }
+    return begin;
+  }
+
+ private:
+  LogFilter _filter;
+  bool _useIndex;
+  std::atomic<bool> _isStop{false};
+};
+
+}  // namespace yoyo
+
+#endif
@@ -0,0 +1,336 @@
+#include <sys/wait.h>
+
+#include "./../src/logreader.hpp"
+using namespace yoyo;
+
+/**
+    @brief 校验日志索引与 LogReader
+    子进程写日志: 先输出若干条再开启索引(索引从非零偏移开始), 退出时触发轮转
+    父进程比较使用索引与整文件扫描在各种过滤条件下的输出是否一致
+*/
+
+int failures = 0;
+
+void check(bool cond, const std::string& what) {
+  std::cout << (cond ? "[PASS] " : "[FAIL] ") << what << std::endl;
+  if (!cond) failures++;
+}
+
+// 配置对之后被工作线程处理的日志生效, 修改前需等待已输出的日志处理完
+void waitProcessed(size_t logNum) {
+  while (Logger::getInstance()->getProcessedNum() < logNum) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+namespace yoyotest {
+struct Worker {
+  static constexpr size_t kLogNum = 400;
+  void run(int batch) {
+    for (size_t i = 0; i < kLogNum; i++) {
+      std::string msg = "batch " + std::to_string(batch) + " item:" +
+                        std::to_string(i) + ":done";
+      switch (i % 50) {
+        case 0:
+          Logger::getInstance()->error(std::move(msg));
+          break;
+        case 1:
+          Logger::getInstance()->warn(std::move(msg));
+          break;
+        case 2:
+          Logger::getInstance()->trace(msg + "\ncontinuation line");
+          break;
+        default:
+          Logger::getInstance()->info(std::move(msg));
+      }
+    }
+  }
+};
+
+// 索引关闭期间输出的 ERROR 不能被索引分段吞掉
+size_t toggleIndex(size_t logNum) {
+  LOGI("toggle before disable");
+  waitProcessed(++logNum);
+  Logger::getInstance()->setIndex(false);
+  LOGE("toggle while index disabled");
+  waitProcessed(++logNum);
+  Logger::getInstance()->setIndex(true);
+  // 填满当前分段, 避免后续的 ERROR 落入同一分段而掩盖问题
+  for (int i = 0; i < 20; i++) {
+    LOGI("toggle after enable");
+  }
+  return logNum + 20;
+}
+}  // namespace yoyotest
+
+void writeLogs() {
+  LOGI("startup before index");
+  LOGD("startup before index");
+  size_t logNum = 2;
+  // 上面的日志处理完后再开启索引, 使索引从非零偏移开始
+  waitProcessed(logNum);
+  Logger::getInstance()->setIndex(true).setIndexInterval(1024);
+  yoyotest::Worker worker;
+  for (int batch = 0; batch < 5; batch++) {
+    worker.run(batch);
+    logNum += yoyotest::Worker::kLogNum;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    if (batch == 2) logNum = yoyotest::toggleIndex(logNum);
+  }
+  // 退出时落盘后文件超过上限, 触发一次轮转
+  Logger::getInstance()->setRotate(true).setFileMaxSize(1);
+}
+
+std::string readAll(LogReader& reader, const std::string& path) {
+  std::string out;
+  reader.read(path, [&out](std::string_view line) { out += line; });
+  return out;
+}
+
+std::string readLine(const std::string& path, size_t lineNo) {
+  std::ifstream ifs(path);
+  std::string line;
+  for (size_t i = 0; i <= lineNo && std::getline(ifs, line); i++) {
+  }
+  return line;
+}
+
+void testParse() {
+  LogRecord rec;
+  bool ok = parseLogLine(
+      "[2024-06-01 10:00:00.123][ERROR][a.cc:void ns::Foo::bar(int):42:x:7:y]",
+      rec);
+  check(ok && rec._time == "2024-06-01 10:00:00.123" && rec._level == "ERROR" &&
+            rec._fileName == "a.cc" &&
+            rec._Function == "void ns::Foo::bar(int)" && rec._Line == "42" &&
+            rec._sMsg == "x:7:y",
+        "parseLogLine with '::' in function name");
+  check(!parseLogLine("continuation line", rec), "parseLogLine rejects text");
+
+  IndexSegment seg;
+  seg._offset = 59;
+  seg._length = 4120;
+  seg._minTime = 1717207200123;
+  seg._maxTime = 1717207200456;
+  seg._levelCount = {1, 2, 3, 4, 5, 6};
+  IndexSegment parsed;
+  check(IndexSegment::parse(seg.serialize(), parsed) &&
+            parsed._offset == seg._offset && parsed._length == seg._length &&
+            parsed._minTime == seg._minTime &&
+            parsed._maxTime == seg._maxTime &&
+            parsed._levelCount == seg._levelCount,
+        "IndexSegment serialize/parse round trip");
+
+  LogFilter filter;
+  filter.setTo("2024-06-01 10:05");
+  LogRecord inside = rec;
+  inside._time = "2024-06-01 10:05:59.999";
+  LogRecord outside = rec;
+  outside._time = "2024-06-01 10:06:00.000";
+  check(filter.match(inside) && !filter.match(outside),
+        "--to fills missing fields with maximum");
+
+  auto at = [&rec](const char* time) {
+    LogRecord r = rec;
+    r._time = time;
+    return r;
+  };
+  LogFilter half;
+  half.setFrom("2024-06-01 10:00:00.5");
+  check(!half.match(at("2024-06-01 10:00:00.499")) &&
+            half.match(at("2024-06-01 10:00:00.500")),
+        "--from .5 means 500 ms");
+  LogFilter truncated;
+  truncated.setTo("2024-06-01 10:00:00.1234");
+  check(truncated.match(at("2024-06-01 10:00:00.123")) &&
+            !truncated.match(at("2024-06-01 10:00:00.124")),
+        "--to .1234 truncated to 123 ms");
+  LogFilter invalid;
+  check(!invalid.setFrom("2024-13-40") && !invalid.setFrom("2024-02-30") &&
+            !invalid.setFrom("2024-06-01 24:00") &&
+            !invalid.setTo("2024-06-01 10:60"),
+        "out-of-range time rejected");
+}
+
+// 索引刻意与内容不符: 中间分段声称没有 ERROR, 使用索引时应跳过该分段
+void testIndexUsed() {
+  std::string lines[3] = {
+      "[2024-06-01 10:00:00.000][ERROR][a.cc:f():1:before index]\n",
+      "[2024-06-01 10:00:01.000][ERROR][a.cc:f():2:indexed]\n",
+      "[2024-06-01 10:00:02.000][ERROR][a.cc:f():3:tail]\n"};
+  std::ofstream("probe.log") << lines[0] << lines[1] << lines[2];
+  IndexSegment seg;
+  seg._offset = lines[0].size();
+  seg._length = lines[1].size();
+  seg._minTime = seg._maxTime = 1717207201000;
+  seg._levelCount[static_cast<int>(LOGLEVEL::INFO)] = 1;
+  std::ofstream("probe.log.idx") << seg.serialize();
+
+  LogFilter error;
+  error.setLevels("error");
+  LogReader indexed(error, true);
+  LogReader scanned(error, false);
+  check(readAll(indexed, "probe.log") == lines[0] + lines[2],
+        "index honored, unindexed prefix and tail scanned");
+  check(readAll(scanned, "probe.log") == lines[0] + lines[1] + lines[2],
+        "--no-index scans whole file");
+}
+
+// 跟踪文件: 不完整的行、跨轮询的续行、轮转与截断, 每行恰好输出一次
+void testFollow() {
+  auto line = [](int no, const char* level, const char* msg) {
+    return "[2024-06-01 10:00:0" + std::to_string(no) + ".000][" + level +
+           "][a.cc:f():" + std::to_string(no) + ":" + msg + "]\n";
+  };
+  const std::string path = "follow.log";
+  auto append = [&path](const std::string& text) {
+    std::ofstream(path, std::ios::app) << text;
+  };
+  std::mutex mtx;
+  std::string out;
+  auto sink = [&](std::string_view text) {
+    std::lock_guard<std::mutex> lock(mtx);
+    out += text;
+  };
+  auto waitOutput = [&](const std::string& expected) {
+    for (int i = 0; i < 5000; i++) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (out == expected) return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  };
+
+  LogFilter error;
+  error.setLevels("error");
+  LogReader reader(error);
+  std::string expected = line(1, "ERROR", "first");
+  std::string partial = line(2, "ERROR", "partial");
+  append(expected + partial.substr(0, 20));
+  size_t offset = reader.read(path, sink, false);
+  check(offset == expected.size() && out == expected,
+        "read stops before partial line");
+
+  std::thread follower([&]() {
+    reader.follow(path, offset, sink, std::chrono::milliseconds(5));
+  });
+  append(partial.substr(20));
+  expected += partial;
+  check(waitOutput(expected), "follow completes partial line");
+
+  std::string header = line(3, "ERROR", "header");
+  append(header);
+  expected += header;
+  check(waitOutput(expected), "follow prints new line");
+  append("continuation of error\n");
+  expected += "continuation of error\n";
+  check(waitOutput(expected), "continuation matched across polls");
+
+  // 轮转前写入的最后内容紧接着被重命名, 需先读完旧文件再读新文件
+  std::string info = line(4, "INFO", "skipped") + "continuation of info\n";
+  std::string last = line(5, "ERROR", "last of old file");
+  std::string first = line(6, "ERROR", "first of new file");
+  append(info + last);
+  std::filesystem::rename(path, path + ".1");
+  append(first);
+  expected += last + first;
+  check(waitOutput(expected), "rotation drains old file then new file");
+
+  std::string truncated = line(7, "ERROR", "t");
+  std::ofstream(path, std::ios::trunc) << truncated;
+  expected += truncated;
+  check(waitOutput(expected), "truncation restarts from beginning");
+
+  reader.stop();
+  follower.join();
+  check(out == expected, "every line printed exactly once");
+}
+
+void testReader(const std::string& path) {
+  IndexSegment first;
+  std::ifstream idx(path + ".idx");
+  std::string line;
+  check(std::getline(idx, line) && IndexSegment::parse(line, first) &&
+            first._offset != 0,
+        "index of " + path + " starts at non-zero offset");
+
+  std::string timeFrom = readLine(path, 300).substr(1, 23);
+  std::string timeTo = readLine(path, 1500).substr(1, 23);
+  std::vector<std::pair<std::string, LogFilter>> filters;
+  filters.emplace_back("no filter", LogFilter());
+  LogFilter error;
+  error.setLevels("error");
+  filters.emplace_back("level error", error);
+  LogFilter warnTrace;
+  warnTrace.setLevels("warn,T");
+  filters.emplace_back("level warn,trace", warnTrace);
+  LogFilter startup;
+  startup.setLevels("debug");
+  filters.emplace_back("level debug (before index)", startup);
+  LogFilter window;
+  window.setFrom(timeFrom);
+  window.setTo(timeTo);
+  filters.emplace_back("time window", window);
+  LogFilter both = window;
+  both.setLevels("error,trace");
+  both.setFunction("Worker::run");
+  filters.emplace_back("time window, level and function", both);
+  LogFilter toggle;
+  toggle.setLevels("error");
+  toggle.setFunction("toggleIndex");
+  filters.emplace_back("error while index disabled", toggle);
+
+  std::ifstream ifs(path);
+  std::string content((std::istreambuf_iterator<char>(ifs)),
+                      std::istreambuf_iterator<char>());
+  for (auto& [name, filter] : filters) {
+    LogReader indexed(filter, true);
+    LogReader scanned(filter, false);
+    std::string withIndex = readAll(indexed, path);
+    std::string withoutIndex = readAll(scanned, path);
+    check(!withIndex.empty() && withIndex == withoutIndex,
+          name + ": indexed == full scan");
+    if (name == "no filter") {
+      check(withIndex == content, name + ": output == file content");
+    }
+  }
+}
+
+int main() {
+  auto dir = std::filesystem::temp_directory_path() / "yoyo_logreader_test";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  std::filesystem::current_path(dir);
+
+  testParse();
+  testIndexUsed();
+  testFollow();
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    writeLogs();
+    exit(0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "writer exited");
+
+  std::vector<std::string> rotated;
+  for (const auto& entry : std::filesystem::directory_iterator("log")) {
+    std::string name = entry.path().string();
+    if (name.find("app_") != std::string::npos && name.ends_with(".log")) {
+      rotated.emplace_back(name);
+    }
+  }
+  check(rotated.size() == 1 && std::filesystem::exists(rotated[0] + ".idx"),
+        "log file rotated with its index");
+  for (const auto& path : rotated) {
+    testReader(path);
+  }
+
+  std::cout << (failures == 0 ? "all passed" : "some checks failed")
+            << std::endl;
+  return failures == 0 ? 0 : 1;
+}
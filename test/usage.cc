@@ -15,6 +15,7 @@
     setConsle -> 是否输出到控制台
     setRotate -> 是否开启日志文件的轮转
     setFileNum -> 日志文件的数量
+    setIndex -> 是否生成日志索引文件(xxx.log.idx), 供 yoyo_cat 快速定位
     ....
 */
 
@@ -0,0 +1,93 @@
+#include "../src/logreader.hpp"
+
+/**
+    @brief 日志查看工具, 配合 setIndex(true) 生成的 xxx.log.idx 快速定位
+    yoyo_cat [options] file...
+    多个文件按参数顺序输出, 如 yoyo_cat log/app_*.log log/app.log
+*/
+
+void usage(const char* name) {
+  std::cerr
+      << "usage: " << name << " [options] file...\n"
+      << "  --from TIME      only logs at or after TIME\n"
+      << "  --to TIME        only logs at or before TIME\n"
+      << "                   TIME: YYYY-MM-DD[ HH[:MM[:SS[.mmm]]]]\n"
+      << "  --level LEVELS   comma separated levels, e.g. error,warn\n"
+      << "  --file STR       source file name contains STR\n"
+      << "  --func STR       function name contains STR\n"
+      << "  -f, --follow     keep reading new logs of the last file\n"
+      << "  --no-index       ignore .idx files and scan the whole file\n"
+      << "  -h, --help       show this message\n";
+}
+
+int main(int argc, char* argv[]) {
+  yoyo::LogFilter filter;
+  std::vector<std::string> files;
+  bool isFollow = false;
+  bool useIndex = true;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    bool isValid = true;
+    if (arg == "-h" || arg == "--help") {
+      usage(argv[0]);
+      return 0;
+    } else if (arg == "-f" || arg == "--follow") {
+      isFollow = true;
+    } else if (arg == "--no-index") {
+      useIndex = false;
+    } else if (arg == "--from") {
+      isValid = hasValue && filter.setFrom(argv[++i]);
+    } else if (arg == "--to") {
+      isValid = hasValue && filter.setTo(argv[++i]);
+    } else if (arg == "--level") {
+      isValid = hasValue && filter.setLevels(argv[++i]);
+    } else if (arg == "--file") {
+      isValid = hasValue;
+      if (isValid) filter.setFileName(argv[++i]);
+    } else if (arg == "--func") {
+      isValid = hasValue;
+      if (isValid) filter.setFunction(argv[++i]);
+    } else if (arg.starts_with("-")) {
+      isValid = false;
+    } else {
+      files.emplace_back(std::move(arg));
+    }
+    if (!isValid) {
+      std::cerr << "invalid option: " << arg << std::endl;
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (files.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  static char outBuffer[1024 * 1024];
+  std::setvbuf(stdout, outBuffer, _IOFBF, sizeof(outBuffer));
+  auto sink = [](std::string_view line) {
+    std::fwrite(line.data(), 1, line.size(), stdout);
+  };
+
+  yoyo::LogReader reader(std::move(filter), useIndex);
+  try {
+    for (size_t i = 0; i < files.size(); i++) {
+      bool isLast = i + 1 == files.size();
+      size_t offset = reader.read(files[i], sink, !(isFollow && isLast));
+      if (isFollow && isLast) {
+        std::fflush(stdout);
+        reader.follow(files[i], offset, [&sink](std::string_view line) {
+          sink(line);
+          std::fflush(stdout);
+        });
+      }
+    }
+  } catch (const std::exception& e) {
+    std::fflush(stdout);
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::fflush(stdout);
+  return 0;
+}